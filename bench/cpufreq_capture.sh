@@ -0,0 +1,69 @@
+#!/system/bin/sh
+# 调频测试负载采集（设备端运行，需要 root）
+#
+# 用 atrace 记录调度（sched_switch）、频率变化（cpu_frequency）与界面绘制（Choreographer#doFrame）事件，
+# 同时导出各簇的 CPU 列表、cpu_capacity、可用频点与 Energy Model。采集期间正常操作手机（滑动列表、打开应用等），
+# 结果拷到电脑上后用 bench/cpufreq_replay.py 以不同的调频器模型回放，对比掉帧数与能耗指标。
+#
+# 用法: sh cpufreq_capture.sh [采集秒数] [输出目录]
+#   采集秒数默认 30，输出目录默认 /data/local/tmp/cpufreq_capture
+# 环境变量: BUF_KB=每个 CPU 的 trace 缓冲区大小(默认 32768)，采集时间长、负载重时 trace 开头丢失可调大
+# 输出:
+#   trace.txt     atrace 文本格式的 trace
+#   clusters.txt  每簇一行 "policyN CPU列表 容量 开始时频率 频点列表"，列表以逗号分隔，频率单位 kHz
+#   em.txt        每行 "簇内首个CPU 频率(kHz) 功耗"，内核未提供 Energy Model 时为空
+#   vsync.txt     屏幕刷新周期（ns）
+
+DURATION=${1:-30}
+OUT=${2:-/data/local/tmp/cpufreq_capture}
+BUF_KB=${BUF_KB:-32768}
+EM=/sys/kernel/debug/energy_model
+
+# ===== 环境检查 =====
+if [ "$(id -u)" != "0" ]; then
+  echo "请使用 root 运行" >&2
+  exit 1
+fi
+if ! command -v atrace > /dev/null; then
+  echo "找不到 atrace" >&2
+  exit 1
+fi
+mkdir -p "$OUT"
+rm -f "$OUT/trace.txt" "$OUT/clusters.txt" "$OUT/em.txt" "$OUT/vsync.txt"
+
+# ===== 导出簇信息 =====
+# 可用频点优先取 scaling_available_frequencies，没有时取 time_in_state 中的频点
+for p in /sys/devices/system/cpu/cpufreq/policy*; do
+  cpus=$(cat "$p/related_cpus" | tr -s ' \n' ',' | sed 's/,$//')
+  cap=$(cat "/sys/devices/system/cpu/cpu${cpus%%,*}/cpu_capacity" 2>/dev/null)
+  freqs=$(cat "$p/scaling_available_frequencies" 2>/dev/null)
+  [ -z "$freqs" ] && freqs=$(awk '{ print $1 }' "$p/stats/time_in_state" 2>/dev/null)
+  freqs=$(echo $freqs | tr ' ' '\n' | sort -n | tr '\n' ',' | sed 's/,$//')
+  echo "${p##*/} $cpus ${cap:-1024} $(cat "$p/scaling_cur_freq") $freqs" >> "$OUT/clusters.txt"
+done
+
+# ===== 导出 Energy Model =====
+[ -d $EM ] || mount -t debugfs debugfs /sys/kernel/debug 2>/dev/null
+touch "$OUT/em.txt"
+for pd in $EM/cpu*; do
+  [ -d "$pd" ] || continue
+  for ps in "$pd"/ps:*; do
+    echo "${pd##*/cpu} $(cat "$ps/frequency") $(cat "$ps/power")" >> "$OUT/em.txt"
+  done
+done
+[ -s "$OUT/em.txt" ] || echo "内核未提供 Energy Model，回放时按频率的三次方估算能耗" >&2
+
+# 第一行为刷新周期（ns）
+dumpsys SurfaceFlinger --latency 2>/dev/null | head -1 > "$OUT/vsync.txt"
+
+# ===== 采集 trace =====
+echo ">>> 正在采集 ${DURATION}s，请在此期间正常操作手机..."
+atrace -b "$BUF_KB" -t "$DURATION" -o "$OUT/trace.txt" sched freq gfx view > /dev/null
+
+# ===== 汇总 =====
+awk '
+  / sched_switch: / { sw++ }
+  / cpu_frequency: / { fq++ }
+  /tracing_mark_write: B\|[0-9]+\|Choreographer#doFrame/ { fr++ }
+  END { printf "调度切换 %d 次，频率变化 %d 次，绘制帧 %d 帧\n", sw, fq, fr }' "$OUT/trace.txt"
+echo "把 $OUT 拷贝到主机后运行: ./bench/cpufreq_replay.py <目录>"
@@ -0,0 +1,397 @@
+#!/usr/bin/env python3
+# 调频器回放对比（在普通主机上运行，不需要 root）
+#
+# 读取 bench/cpufreq_capture.sh 在手机上采集的 trace，把每段运行时间按当时的频率与 cpu_capacity 换算成工作量，
+# 再在各个调频器模型下按原到达时间、在原 CPU 上重新执行这些工作：
+#   recorded      采集时实际的频率变化（用于检验模型，结果应接近采集时的实际掉帧）
+#   schedutil     6.1 schedutil：频率 = 1.25 * 最高频率 * util / 容量，单一 rate_limit_us
+#   schedhorizon  other_patch/schedhorizon.patch 的同一套逻辑，参数与设备上 sysfs 中的可调参数一一对应
+# util 按 PELT 的方式（32ms 半衰期、频率不变性）由模拟中的运行时间计算，每 TICK_US 更新一次频率。
+# 每帧的工作量为 UI 线程在 Choreographer#doFrame 内的运行时间，模拟完成时间晚于 开始时间 + 刷新周期 记为掉帧。
+# 能耗指标为各 CPU 运行时的 Energy Model 功耗 × 时间（mJ，功耗单位取决于内核），没有 EM 时用 容量 × (频率/最高频率)^3 估算。
+# 模型不包含任务迁移、任务间依赖与 RenderThread/SurfaceFlinger 的工作，只适合在同一份采集上横向对比。
+#
+# 用法: ./cpufreq_replay.py <采集目录> [-g 调频器列表] [--conf 参数文件] [--vsync-ns 刷新周期]
+#   调频器列表用逗号分隔，默认 "recorded,schedutil,schedhorizon"
+#   参数文件每行 "policyN 参数 值"，与设备上 /sys/devices/system/cpu/cpufreq/policyN/schedhorizon/参数 对应，
+#   例如 "policy4 target_loads 80 1996800:90"；schedutil 的 rate_limit_us 也用同样的格式指定
+#   未指定的参数取内核默认值，此时 schedhorizon 与 schedutil 的行为相同
+
+import argparse
+import bisect
+import math
+import os
+import re
+import sys
+
+TICK_US = 500
+PELT_HALFLIFE_US = 32000
+DEFAULT_RATE_LIMIT_US = 1000
+TREND_MIN_US = 1000
+
+LINE_RE = re.compile(r"^\s*(.*?)-(\d+)\s+(?:\(\s*[-\d]+\)\s+)?\[(\d+)\]\s+(?:\S+\s+)?(\d+\.\d+):\s+(\w+):\s?(.*)$")
+KV_RE = re.compile(r"(\w+)=(\S+)")
+
+
+class Cluster:
+    def __init__(self, name, cpus, cap, cur, freqs):
+        self.name = name
+        self.cpus = cpus
+        self.cap = cap
+        self.cur = cur
+        self.freqs = freqs
+        self.fmax = freqs[-1]
+        self.power = {}
+
+    def resolve(self, freq):
+        i = bisect.bisect_left(self.freqs, freq)
+        return self.freqs[min(i, len(self.freqs) - 1)]
+
+    def cost(self, freq):
+        """运行 1us 的能耗（uJ 或估算指标）"""
+        if self.power:
+            return self.power[freq] / 1000
+        return self.cap / 1024 * (freq / self.fmax) ** 3
+
+
+def load_clusters(path):
+    clusters = []
+    with open(os.path.join(path, "clusters.txt")) as f:
+        for line in f:
+            name, cpus, cap, cur, freqs = line.split()
+            clusters.append(Cluster(name, [int(c) for c in cpus.split(",")], int(cap), int(cur),
+                                    sorted(int(x) for x in freqs.split(","))))
+    em = {}
+    try:
+        with open(os.path.join(path, "em.txt")) as f:
+            for line in f:
+                cpu, freq, power = (int(x) for x in line.split())
+                em.setdefault(cpu, {})[freq] = power
+    except FileNotFoundError:
+        pass
+    for c in clusters:
+        table = em.get(c.cpus[0])
+        if not table:
+            continue
+        # EM 的频点与 cpufreq 的频点可能不完全一致，按不低于该频率的最近 EM 频点取功耗
+        keys = sorted(table)
+        c.power = {fr: table[keys[min(bisect.bisect_left(keys, fr), len(keys) - 1)]] for fr in c.freqs}
+    return clusters
+
+
+def load_trace(path, clusters):
+    """返回 (各 CPU 的运行片段 [开始us, 结束us, tid], 各 CPU 的频率变化 [(us, kHz)], 帧 [(tid, 开始us, 结束us)])"""
+    cpu_cluster = {cpu: c for c in clusters for cpu in c.cpus}
+    running = {}
+    slices = {cpu: [] for cpu in cpu_cluster}
+    freq_events = {cpu: [] for cpu in cpu_cluster}
+    stacks = {}
+    frames = []
+    first = last = None
+
+    with open(os.path.join(path, "trace.txt"), errors="replace") as f:
+        for line in f:
+            m = LINE_RE.match(line)
+            if not m:
+                continue
+            _comm, tid, cpu, ts, event, args = m.groups()
+            tid, cpu, us = int(tid), int(cpu), int(float(ts) * 1e6)
+            first = us if first is None else first
+            last = us
+            if event == "sched_switch":
+                kv = dict(KV_RE.findall(args))
+                cur = running.pop(cpu, None)
+                if cur and cpu in slices and us > cur[1]:
+                    slices[cpu].append([cur[1], us, cur[0]])
+                nxt = int(kv.get("next_pid", 0))
+                if nxt:
+                    running[cpu] = (nxt, us)
+            elif event == "cpu_frequency":
+                kv = dict(KV_RE.findall(args))
+                c = int(kv["cpu_id"])
+                if c in freq_events:
+                    freq_events[c].append((us, int(kv["state"])))
+            elif event == "tracing_mark_write":
+                stack = stacks.setdefault(tid, [])
+                if args.startswith("B|"):
+                    name = args.split("|", 2)[2] if args.count("|") >= 2 else ""
+                    stack.append((name, us))
+                elif args.startswith("E") and stack:
+                    name, start = stack.pop()
+                    # 只取最外层的 doFrame，内层的同名片段属于同一帧
+                    if name.startswith("Choreographer#doFrame") and \
+                            not any(n.startswith("Choreographer#doFrame") for n, _ in stack):
+                        frames.append((tid, start, us))
+
+    if first is None:
+        sys.exit("trace 为空或格式无法识别: %s/trace.txt" % path)
+    for cpu, (tid, start) in running.items():
+        if cpu in slices and last > start:
+            slices[cpu].append([start, last, tid])
+    return slices, freq_events, frames, first, last
+
+
+def freq_at(events, initial):
+    """返回按时间单调查询录制频率的函数"""
+    times = [t for t, _ in events]
+
+    def lookup(us):
+        i = bisect.bisect_right(times, us)
+        return events[i - 1][1] if i else initial
+    return lookup
+
+
+def build_jobs(clusters, slices, freq_events, frames):
+    """把运行片段换算为工作量（在该簇最高频率下需要运行的 us），并在帧的边界处切开 UI 线程的片段"""
+    by_tid = {}
+    for n, (tid, start, end) in enumerate(frames):
+        by_tid.setdefault(tid, []).append((start, end, n))
+
+    jobs = {}
+    for c in clusters:
+        rec = {cpu: freq_at(freq_events[cpu], c.cur) for cpu in c.cpus}
+        for cpu in c.cpus:
+            out = []
+            for start, end, tid in slices[cpu]:
+                cuts = [(start, end, None)]
+                for fs, fe, n in by_tid.get(tid, ()):
+                    if fe <= start or fs >= end:
+                        continue
+                    nxt = []
+                    for s, e, fr in cuts:
+                        if fr is not None or fe <= s or fs >= e:
+                            nxt.append((s, e, fr))
+                            continue
+                        if s < fs:
+                            nxt.append((s, fs, None))
+                        nxt.append((max(s, fs), min(e, fe), n))
+                        if fe < e:
+                            nxt.append((fe, e, None))
+                    cuts = nxt
+                for s, e, fr in cuts:
+                    # 片段内的频率变化按片段开始时的频率近似
+                    work = (e - s) * rec[cpu](s) / c.fmax
+                    if work > 0:
+                        out.append((s, work, fr))
+            jobs[cpu] = out
+    return jobs
+
+
+def parse_conf(path):
+    conf = {}
+    if not path:
+        return conf
+    with open(path) as f:
+        for line in f:
+            parts = line.split(None, 2)
+            if len(parts) == 3 and not parts[0].startswith("#"):
+                conf.setdefault(parts[0], {})[parts[1]] = parts[2].strip()
+    return conf
+
+
+class Schedutil:
+    def __init__(self, cluster, conf):
+        self.c = cluster
+        self.rate_us = int(conf.get("rate_limit_us", DEFAULT_RATE_LIMIT_US))
+        self.last = -math.inf
+        self.freq = cluster.cur
+
+    def update(self, now, utils):
+        if now - self.last < self.rate_us:
+            return self.freq
+        util = max(utils.values())
+        nxt = self.c.resolve(self.c.fmax * 1.25 * util / self.c.cap)
+        if nxt != self.freq:
+            self.freq = nxt
+            self.last = now
+        return self.freq
+
+
+class Schedhorizon:
+    """与 kernel/sched/cpufreq_schedhorizon.c 相同的频率选择逻辑"""
+
+    def __init__(self, cluster, conf):
+        self.c = cluster
+        self.up_rate_us = int(conf.get("up_rate_limit_us", DEFAULT_RATE_LIMIT_US))
+        self.down_rate_us = int(conf.get("down_rate_limit_us", DEFAULT_RATE_LIMIT_US))
+        self.horizon_us = int(conf.get("predict_horizon_us", 0))
+        self.loads = [int(x) for x in re.split(r"[\s:]+", conf.get("target_loads", "80").strip())]
+        eff = conf.get("efficient_freq", "").split()
+        delay = conf.get("up_delay", "").split()
+        self.steps = [(int(f), int(d) * 1000) for f, d in zip(eff, delay) if int(f)]
+        self.up_since = [None] * len(self.steps)
+        self.trend = {cpu: (0.0, -math.inf, 0.0) for cpu in cluster.cpus}
+        self.last = -math.inf
+        self.freq = cluster.cur
+
+    def target_load(self, freq):
+        i = 0
+        while i < len(self.loads) - 1 and freq >= self.loads[i + 1]:
+            i += 2
+        return self.loads[i]
+
+    def predict(self, cpu, now, util):
+        t_util, t_time, slope = self.trend[cpu]
+        if now - t_time >= TREND_MIN_US:
+            slope = (util - t_util) * 1000 / (now - t_time) if t_time > -math.inf else 0.0
+            self.trend[cpu] = (util, now, slope)
+        if self.horizon_us and slope > 0:
+            util = min(util + slope * self.horizon_us / 1000, self.c.cap)
+        return util
+
+    def hold_efficient(self, now, freq):
+        target = freq
+        i = 0
+        while i < len(self.steps):
+            eff, delay = self.steps[i]
+            if freq <= eff:
+                break
+            if self.up_since[i] is None:
+                self.up_since[i] = now
+            i += 1
+            if now - self.up_since[i - 1] < delay:
+                target = eff
+                break
+        for j in range(i, len(self.steps)):
+            self.up_since[j] = None
+        return freq if target == freq else self.c.resolve(target)
+
+    def update(self, now, utils):
+        if now - self.last < min(self.up_rate_us, self.down_rate_us):
+            return self.freq
+        util = max(self.predict(cpu, now, u) for cpu, u in utils.items())
+        raw = self.c.fmax * util / self.c.cap
+        load = self.target_load(raw)
+        nxt = raw * 100 / load
+        if self.target_load(nxt) != load:
+            nxt = raw * 100 / self.target_load(nxt)
+        nxt = self.hold_efficient(now, self.c.resolve(nxt))
+        delta = now - self.last
+        if nxt == self.freq or (nxt > self.freq and delta < self.up_rate_us) or \
+                (nxt < self.freq and delta < self.down_rate_us):
+            return self.freq
+        self.freq = nxt
+        self.last = now
+        return self.freq
+
+
+class Recorded:
+    def __init__(self, cluster, freq_events):
+        self.lookup = freq_at(freq_events[cluster.cpus[0]], cluster.cur)
+
+    def update(self, now, _utils):
+        return self.lookup(now)
+
+
+def simulate(clusters, jobs, frames, first, last, make_gov):
+    """逐 TICK_US 执行各 CPU 的工作队列，返回 (各帧的模拟完成时间, 能耗)"""
+    decay = 0.5 ** (TICK_US / PELT_HALFLIFE_US)
+    remaining = [0] * len(frames)
+    for cpu_jobs in jobs.values():
+        for _s, _w, fr in cpu_jobs:
+            if fr is not None:
+                remaining[fr] += 1
+    done = [None] * len(frames)
+    energy = 0.0
+
+    for c in clusters:
+        gov = make_gov(c)
+        state = {cpu: {"q": jobs[cpu], "i": 0, "left": None, "util": 0.0} for cpu in c.cpus}
+        freq = c.cur
+        now = first
+        while now < last or any(s["i"] < len(s["q"]) for s in state.values()):
+            end = now + TICK_US
+            rate = freq / c.fmax
+            for cpu, s in state.items():
+                t = now
+                busy = 0.0
+                q = s["q"]
+                while t < end and s["i"] < len(q):
+                    start, work, fr = q[s["i"]]
+                    if s["left"] is None:
+                        if start >= end:
+                            break
+                        t = max(t, start)
+                        s["left"] = work
+                    need = s["left"] / rate
+                    if t + need <= end:
+                        busy += need
+                        t += need
+                        s["left"] = None
+                        s["i"] += 1
+                        if fr is not None:
+                            remaining[fr] -= 1
+                            if remaining[fr] == 0:
+                                done[fr] = t
+                    else:
+                        busy += end - t
+                        s["left"] -= (end - t) * rate
+                        t = end
+                energy += busy * c.cost(freq)
+                # PELT：运行比例 × 容量 × 频率比，按半衰期衰减
+                s["util"] = s["util"] * decay + busy / TICK_US * c.cap * rate * (1 - decay)
+            now = end
+            freq = gov.update(now, {cpu: s["util"] for cpu, s in state.items()})
+    return done, energy
+
+
+def percentile(vals, p):
+    if not vals:
+        return float("nan")
+    vals = sorted(vals)
+    return vals[min(len(vals) - 1, int(len(vals) * p / 100))]
+
+
+def main():
+    ap = argparse.ArgumentParser(description="以不同调频器模型回放手机采集的 trace，对比掉帧与能耗")
+    ap.add_argument("capture", help="cpufreq_capture.sh 的输出目录")
+    ap.add_argument("-g", "--govs", default="recorded,schedutil,schedhorizon", help="逗号分隔的调频器列表")
+    ap.add_argument("--conf", help="各簇参数文件，每行 \"policyN 参数 值\"")
+    ap.add_argument("--vsync-ns", type=int, default=0, help="刷新周期（ns），默认取采集时的值")
+    args = ap.parse_args()
+
+    clusters = load_clusters(args.capture)
+    vsync = args.vsync_ns
+    if not vsync:
+        try:
+            with open(os.path.join(args.capture, "vsync.txt")) as f:
+                vsync = int(f.read().split()[0])
+        except (FileNotFoundError, IndexError, ValueError):
+            vsync = 16666667
+    vsync_us = vsync / 1000
+    conf = parse_conf(args.conf)
+
+    slices, freq_events, frames, first, last = load_trace(args.capture, clusters)
+    jobs = build_jobs(clusters, slices, freq_events, frames)
+    if not frames:
+        print("警告: trace 中没有 Choreographer#doFrame，只能对比能耗", file=sys.stderr)
+    has_em = all(c.power for c in clusters)
+    print(">>> trace 时长 %.1fs，%d 帧，刷新周期 %.2fms，能耗%s"
+          % ((last - first) / 1e6, len(frames), vsync_us / 1000,
+             "按 Energy Model 计算（mJ）" if has_em else "按 容量 × 频率比^3 估算（相对值）"))
+    rec_miss = sum(1 for _tid, s, e in frames if e - s > vsync_us)
+    print(">>> 采集时实际超过一个刷新周期的帧: %d" % rec_miss)
+
+    makers = {
+        "recorded": lambda c: Recorded(c, freq_events),
+        "schedutil": lambda c: Schedutil(c, conf.get(c.name, {})),
+        "schedhorizon": lambda c: Schedhorizon(c, conf.get(c.name, {})),
+    }
+    print("%-14s %8s %8s %10s %10s %10s %12s %8s"
+          % ("调频器", "帧数", "掉帧", "掉帧率%", "帧P90ms", "帧P99ms", "能耗", "相对%"))
+    base = None
+    for gov in args.govs.split(","):
+        if gov not in makers:
+            print("跳过 %s（未知的调频器）" % gov, file=sys.stderr)
+            continue
+        done, energy = simulate(clusters, jobs, frames, first, last, makers[gov])
+        lat = [(d - s) / 1000 for d, (_tid, s, _e) in zip(done, frames) if d is not None]
+        miss = sum(1 for x in lat if x > vsync_us / 1000)
+        base = base or energy
+        print("%-14s %8d %8d %10.2f %10.2f %10.2f %12.1f %8.1f"
+              % (gov, len(lat), miss, miss * 100 / max(len(lat), 1), percentile(lat, 90),
+                 percentile(lat, 99), energy / 1000, energy * 100 / base if base else 0))
+
+
+if __name__ == "__main__":
+    main()
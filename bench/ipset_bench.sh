@@ -0,0 +1,176 @@
+#!/bin/bash
+# ipset 单包匹配开销基准测试（在普通 Linux 主机上运行，需要 root）
+#
+# "网络功能增强" 选项会把全部 IP_SET_HASH_* 类型编进内核，代理/防火墙类软件常用它们
+# 加载上万条的 CN/GeoIP 网段集合，而 xt_set 会在每个包上查询一次集合。
+# 本脚本用 veth + netns + 内核 pktgen 发包，对比不同集合类型/规模下每个包多花多少 ns：
+#   hash:ip        单 IP 集合
+#   hash:net       原始网段集合（hash:net 每个包要按集合中出现过的每种前缀长度各查一次哈希）
+#   hash:net-norm  把网段统一展开为 /16、/24、/32 三种前缀后的 hash:net（最多查 3 次）
+#   nft-interval   nftables 区间集合（按前缀最长匹配的树形结构，需要系统有 nft）
+#
+# 用法: sudo ./ipset_bench.sh [集合规模列表] [网段文件]
+#   集合规模列表默认 "1000 10000 50000"；
+#   网段文件每行一个 a.b.c.d/len（如 CN 列表），不提供时按随机 /8~/32 网段生成。
+# 环境变量: COUNT=每轮发包数(默认 2000000) TYPES=要测试的集合类型(默认全部)
+set -e
+
+SIZES=${1:-"1000 10000 50000"}
+PREFIX_FILE=$2
+COUNT=${COUNT:-2000000}
+TYPES=${TYPES:-"hash:ip hash:net hash:net-norm nft-interval"}
+NS=ipsb
+SET=ipsb_set
+PG_DIR=/proc/net/pktgen
+WORKDIR=$(mktemp -d)
+
+# ===== 环境检查 =====
+if [ "$(id -u)" != "0" ]; then
+  echo "请使用 root 运行" >&2
+  exit 1
+fi
+for cmd in ip ipset iptables awk; do
+  command -v "$cmd" >/dev/null || { echo "缺少命令: $cmd" >&2; exit 1; }
+done
+modprobe pktgen
+modprobe veth
+command -v nft >/dev/null || TYPES=$(echo "$TYPES" | sed 's/nft-interval//')
+
+cleanup() {
+  echo "stop" > $PG_DIR/pgctrl 2>/dev/null || true
+  echo "rem_device_all" > $PG_DIR/kpktgend_0 2>/dev/null || true
+  ip netns del $NS 2>/dev/null || true
+  ip link del vtx 2>/dev/null || true
+  rm -rf "$WORKDIR"
+}
+trap cleanup EXIT
+
+# ===== 创建 veth 对，接收端放入独立 netns =====
+echo ">>> 创建 veth 测试网络..."
+ip netns add $NS
+ip link add vtx type veth peer name vrx
+ip link set vrx netns $NS
+ip addr add 10.255.0.1/30 dev vtx
+ip link set vtx up
+ip netns exec $NS ip addr add 10.255.0.2/30 dev vrx
+ip netns exec $NS ip link set vrx up
+ip netns exec $NS ip link set lo up
+DST_MAC=$(ip netns exec $NS cat /sys/class/net/vrx/address)
+
+# ===== 生成网段列表 =====
+# 随机网段：前缀长度在 /8~/32 之间分布，模拟 GeoIP 列表中前缀长度五花八门的情况
+gen_prefixes() {
+  awk -v n="$1" -v seed="$2" 'BEGIN {
+    srand(seed)
+    for (i = 0; i < n; i++) {
+      len = 8 + int(rand() * 25)
+      ip = int(rand() * 4294967296)
+      ip = ip - ip % (2 ^ (32 - len))
+      printf "%d.%d.%d.%d/%d\n", int(ip / 16777216) % 256, int(ip / 65536) % 256,
+             int(ip / 256) % 256, ip % 256, len
+    }
+  }'
+}
+
+# 把任意前缀展开为 /16、/24、/32 三档，展开后 hash:net 每个包最多只需查 3 次哈希
+normalize_prefixes() {
+  awk -F'[./]' '{
+    ip = $1 * 16777216 + $2 * 65536 + $3 * 256 + $4
+    len = ($5 == "") ? 32 : $5
+    if (len <= 16) { to = 16 } else if (len <= 24) { to = 24 } else { to = 32 }
+    step = 2 ^ (32 - to)
+    for (k = 0; k < 2 ^ (to - len); k++) {
+      a = ip + k * step
+      printf "%d.%d.%d.%d/%d\n", int(a / 16777216) % 256, int(a / 65536) % 256,
+             int(a / 256) % 256, a % 256, to
+    }
+  }' | sort -u
+}
+
+# ===== 加载集合与匹配规则 =====
+load_rules() {
+  local type=$1 list=$2
+  ip netns exec $NS iptables -t raw -F PREROUTING
+  ip netns exec $NS ipset destroy $SET 2>/dev/null || true
+  ip netns exec $NS nft delete table inet $NS 2>/dev/null || true
+  case "$type" in
+    none)
+      ;;
+    hash:ip)
+      cut -d/ -f1 "$list" | awk -v s=$SET 'BEGIN { print "create " s " hash:ip maxelem 1048576" } { print "add " s " " $1 " -exist" }' \
+        | ip netns exec $NS ipset restore
+      ip netns exec $NS iptables -t raw -A PREROUTING -i vrx -m set --match-set $SET src -j DROP
+      ;;
+    hash:net|hash:net-norm)
+      awk -v s=$SET 'BEGIN { print "create " s " hash:net maxelem 4194304" } { print "add " s " " $1 " -exist" }' "$list" \
+        | ip netns exec $NS ipset restore
+      ip netns exec $NS iptables -t raw -A PREROUTING -i vrx -m set --match-set $SET src -j DROP
+      ;;
+    nft-interval)
+      {
+        echo "table inet $NS {"
+        echo "  set s { type ipv4_addr; flags interval; auto-merge; elements = {"
+        awk 'NR > 1 { printf ",\n" } { printf "    %s", $1 } END { print "" }' "$list"
+        echo "  } }"
+        echo "  chain pre { type filter hook prerouting priority -300; iifname \"vrx\" ip saddr @s drop; }"
+        echo "}"
+      } > "$WORKDIR/nft.conf"
+      ip netns exec $NS nft -f "$WORKDIR/nft.conf"
+      ;;
+  esac
+  # 未命中集合的包统一在此丢弃，保证各组测试的收包路径一致
+  ip netns exec $NS iptables -t raw -A PREROUTING -i vrx -j DROP
+}
+
+# ===== pktgen 发包并返回 pps =====
+run_pktgen() {
+  echo "rem_device_all" > $PG_DIR/kpktgend_0
+  echo "add_device vtx" > $PG_DIR/kpktgend_0
+  local pg=$PG_DIR/vtx
+  echo "count $COUNT" > $pg
+  echo "clone_skb 0" > $pg
+  echo "pkt_size 64" > $pg
+  echo "delay 0" > $pg
+  echo "dst 10.255.0.2" > $pg
+  echo "dst_mac $DST_MAC" > $pg
+  # 源地址在全部 IPv4 空间内随机，绝大部分包会走完整的未命中查找路径（最坏情况）
+  echo "src_min 1.0.0.0" > $pg
+  echo "src_max 223.255.255.255" > $pg
+  echo "flag IPSRC_RND" > $pg
+  echo "start" > $PG_DIR/pgctrl
+  grep -o '[0-9]*pps' $pg | head -n1 | tr -d 'ps'
+}
+
+# pktgen 线程固定在 CPU0；同一 CPU 上发包与收包（veth 在 local_bh_enable 时同步处理接收软中断），pps 的倒数即为单包总开销
+ns_per_pkt() {
+  awk -v p="$1" 'BEGIN { if (p > 0) printf "%.1f", 1e9 / p; else print "NaN" }'
+}
+
+echo ">>> 测量基线（无集合匹配）..."
+load_rules none /dev/null
+BASE_PPS=$(run_pktgen)
+BASE_NS=$(ns_per_pkt "$BASE_PPS")
+echo "基线: ${BASE_PPS} pps, ${BASE_NS} ns/包"
+echo
+
+printf "%-14s %10s %10s %8s %12s %12s\n" "类型" "网段数" "条目数" "前缀种类" "ns/包" "额外ns/包"
+for size in $SIZES; do
+  if [ -n "$PREFIX_FILE" ]; then
+    head -n "$size" "$PREFIX_FILE" > "$WORKDIR/raw.txt"
+  else
+    gen_prefixes "$size" 4242 > "$WORKDIR/raw.txt"
+  fi
+  normalize_prefixes < "$WORKDIR/raw.txt" > "$WORKDIR/norm.txt"
+  for type in $TYPES; do
+    list="$WORKDIR/raw.txt"
+    [ "$type" = "hash:net-norm" ] && list="$WORKDIR/norm.txt"
+    load_rules "$type" "$list"
+    pps=$(run_pktgen)
+    cost=$(ns_per_pkt "$pps")
+    entries=$(wc -l < "$list")
+    cidrs=$(awk -F/ '{ print $2 }' "$list" | sort -u | wc -l)
+    [ "$type" = "hash:ip" ] && cidrs=1
+    extra=$(awk -v a="$cost" -v b="$BASE_NS" 'BEGIN { printf "%.1f", a - b }')
+    printf "%-14s %10s %10s %8s %12s %12s\n" "$type" "$size" "$entries" "$cidrs" "$cost" "$extra"
+  done
+done
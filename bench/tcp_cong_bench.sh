@@ -0,0 +1,105 @@
+#!/bin/bash
+# TCP 拥塞控制算法弱网基准测试（在普通 Linux 主机上运行，需要 root、iperf3、ping）
+#
+# 用两个 netns + veth 搭建链路，在两端出口用 netem 模拟 Wi-Fi、4G/5G 蜂窝及弱网，
+# 对每种链路分别测试各拥塞控制算法的上行吞吐，以及满载时的 ping 时延（反映排队膨胀）。
+# BBR 在蜂窝上行表现好、在部分 Wi-Fi 上却会抢占带宽并推高时延，单一全局默认算法总有一边吃亏，
+# 测试结果可作为 tools/tcp_cong_policy.sh 按网卡选择算法的依据。
+#
+# 用法: sudo ./tcp_cong_bench.sh [算法列表] [链路列表]
+#   算法列表默认 "cubic bbr westwood htcp vegas nv"（Brutal 需应用层设置速率，不参与测试）
+#   链路列表默认 "wifi 5g lte weak"
+# 环境变量: DURATION=每组测试秒数(默认 20)
+set -e
+
+ALGS=${1:-"cubic bbr westwood htcp vegas nv"}
+LINKS=${2:-"wifi 5g lte weak"}
+DURATION=${DURATION:-20}
+NS_C=tccb_c
+NS_S=tccb_s
+WORKDIR=$(mktemp -d)
+
+# 链路参数: 单向时延 抖动 丢包率 带宽
+link_params() {
+  case "$1" in
+    wifi) echo "10ms 2ms 0.1% 200mbit" ;;
+    5g)   echo "15ms 5ms 0.5% 100mbit" ;;
+    lte)  echo "30ms 10ms 1% 20mbit" ;;
+    weak) echo "75ms 25ms 3% 5mbit" ;;
+    *)    echo "未知链路类型: $1" >&2; return 1 ;;
+  esac
+}
+
+# ===== 环境检查 =====
+if [ "$(id -u)" != "0" ]; then
+  echo "请使用 root 运行" >&2
+  exit 1
+fi
+for cmd in ip tc iperf3 ping awk; do
+  command -v "$cmd" >/dev/null || { echo "缺少命令: $cmd" >&2; exit 1; }
+done
+for alg in $ALGS; do
+  modprobe "tcp_$alg" 2>/dev/null || true
+done
+
+cleanup() {
+  ip netns pids $NS_S 2>/dev/null | xargs -r kill 2>/dev/null || true
+  ip netns del $NS_C 2>/dev/null || true
+  ip netns del $NS_S 2>/dev/null || true
+  rm -rf "$WORKDIR"
+}
+trap cleanup EXIT
+
+# ===== 创建测试网络 =====
+echo ">>> 创建 netns 测试网络..."
+ip netns add $NS_C
+ip netns add $NS_S
+ip link add veth_c netns $NS_C type veth peer name veth_s netns $NS_S
+ip -n $NS_C addr add 10.254.0.1/30 dev veth_c
+ip -n $NS_S addr add 10.254.0.2/30 dev veth_s
+ip -n $NS_C link set veth_c up
+ip -n $NS_S link set veth_s up
+ip -n $NS_C link set lo up
+ip -n $NS_S link set lo up
+
+# 在两个方向上设置 netem（时延/抖动/丢包），并在发送方向用 netem 自带的 rate 限速
+set_link() {
+  local delay jitter loss rate
+  read -r delay jitter loss rate <<< "$(link_params "$1")"
+  for pair in "$NS_C veth_c" "$NS_S veth_s"; do
+    set -- $pair
+    ip netns exec "$1" tc qdisc replace dev "$2" root netem \
+      delay "$delay" "$jitter" distribution normal loss "$loss" rate "$rate" limit 1000
+  done
+}
+
+run_one() {
+  local alg=$1
+  ip netns exec $NS_S pkill iperf3 2>/dev/null || true
+  ip netns exec $NS_S iperf3 -s -D >/dev/null 2>&1
+  sleep 0.5
+  # 满载期间每 0.2s ping 一次，统计排队时延
+  ip netns exec $NS_C ping -i 0.2 -w "$DURATION" 10.254.0.2 > "$WORKDIR/ping.txt" 2>/dev/null &
+  local ping_pid=$!
+  ip netns exec $NS_C iperf3 -c 10.254.0.2 -C "$alg" -t "$DURATION" -J > "$WORKDIR/iperf.json" 2>/dev/null || true
+  wait $ping_pid 2>/dev/null || true
+  local mbps retrans
+  mbps=$(grep -A8 '"sum_sent"' "$WORKDIR/iperf.json" | awk -F': ' '/bits_per_second/ { gsub(",", "", $2); printf "%.1f", $2 / 1e6; exit }')
+  retrans=$(grep -A8 '"sum_sent"' "$WORKDIR/iperf.json" | awk -F': ' '/retransmits/ { gsub(",", "", $2); print $2; exit }')
+  # 取 ping RTT 的平均值与 95 分位
+  read -r avg p95 <<< "$(awk -F'time=' '/time=/ { split($2, a, " "); print a[1] }' "$WORKDIR/ping.txt" | sort -n \
+    | awk '{ v[NR] = $1; s += $1 } END { if (NR) printf "%.1f %.1f", s / NR, v[int(NR * 0.95) > 0 ? int(NR * 0.95) : 1]; else print "NaN NaN" }')"
+  printf "%-8s %-10s %10s %8s %10s %10s\n" "$LINK" "$alg" "${mbps:-0}" "${retrans:-0}" "$avg" "$p95"
+}
+
+printf "%-8s %-10s %10s %8s %10s %10s\n" "链路" "算法" "Mbit/s" "重传" "RTT均值ms" "RTT P95ms"
+for LINK in $LINKS; do
+  set_link "$LINK"
+  for alg in $ALGS; do
+    if ! grep -qw "$alg" /proc/sys/net/ipv4/tcp_available_congestion_control; then
+      echo "跳过 $alg（内核未提供该算法）" >&2
+      continue
+    fi
+    run_one "$alg"
+  done
+done
@@ -0,0 +1,106 @@
+#!/system/bin/sh
+# zram 压缩算法 swap-in 延迟基准测试（设备端运行，需要 root）
+#
+# 新建一个临时 zram 设备（不影响正在使用的 zram0），依次用各算法写入同一份语料，
+# 清掉页缓存后按顺序读回：每读一页 zram 都要解压一次，读回耗时即近似 swap-in 时用户感知到的解压延迟。
+# 同时记录写入耗时（压缩）与 mm_stat 中的压缩率，用于对比 lz4、zstd 与 zstd-fastdec
+# （zram_patch/003-zstd-fastdec.patch：关闭字面量哈夫曼编码并提高最小匹配长度，以少量压缩率换解压速度）。
+#
+# 用法: sh zram_alg_bench.sh [算法列表] [语料文件]
+#   算法列表默认 "lz4 zstd zstd-fastdec"，内核未提供的算法自动跳过
+#   语料文件默认拼接 /system/lib64 与 /data/dalvik-cache 下的文件，截取前 SIZE_MB
+# 环境变量: SIZE_MB=语料大小(默认 256) ROUNDS=读回轮数，取最快一轮(默认 3) CPU=绑定的 CPU 编号(默认 7)
+
+ALGS=${1:-"lz4 zstd zstd-fastdec"}
+CORPUS=$2
+SIZE_MB=${SIZE_MB:-256}
+ROUNDS=${ROUNDS:-3}
+CPU=${CPU:-7}
+WORKDIR=/data/local/tmp/zram_alg_bench
+
+# ===== 环境检查 =====
+if [ "$(id -u)" != "0" ]; then
+  echo "请使用 root 运行" >&2
+  exit 1
+fi
+if [ ! -e /sys/class/zram-control/hot_add ]; then
+  echo "内核不支持 zram-control/hot_add，无法创建测试设备" >&2
+  exit 1
+fi
+mkdir -p "$WORKDIR"
+
+now_ns() {
+  date +%s%N
+}
+
+# 纳秒差值可能超出 shell 的整数范围，统一交给 awk 计算
+elapsed_ms() {
+  awk -v a="$1" -v b="$2" 'BEGIN { printf "%.3f", (b - a) / 1e6 }'
+}
+
+# ===== 准备语料 =====
+if [ -z "$CORPUS" ]; then
+  CORPUS="$WORKDIR/corpus.bin"
+  echo ">>> 正在生成 ${SIZE_MB}MB 语料..."
+  find /system/lib64 /data/dalvik-cache -type f 2>/dev/null | while read -r f; do
+    cat "$f"
+  done | head -c $((SIZE_MB * 1048576)) > "$CORPUS"
+fi
+CORPUS_BYTES=$(wc -c < "$CORPUS")
+PAGES=$((CORPUS_BYTES / 4096))
+if [ "$PAGES" -eq 0 ]; then
+  echo "语料为空: $CORPUS" >&2
+  exit 1
+fi
+
+# ===== 创建临时 zram 设备 =====
+ID=$(cat /sys/class/zram-control/hot_add)
+SYS=/sys/block/zram$ID
+DEV=/dev/block/zram$ID
+[ -e "$DEV" ] || DEV=/dev/zram$ID
+
+cleanup() {
+  echo 1 > "$SYS/reset" 2>/dev/null
+  echo "$ID" > /sys/class/zram-control/hot_remove 2>/dev/null
+  [ "$CORPUS" = "$WORKDIR/corpus.bin" ] && rm -rf "$WORKDIR"
+}
+trap cleanup EXIT INT TERM
+
+echo ">>> 测试设备 zram$ID，语料 $CORPUS（$PAGES 页），绑定 CPU$CPU"
+printf "%-14s %8s %12s %12s %12s\n" "算法" "压缩率" "写入MB/s" "读回MB/s" "读回us/页"
+for alg in $ALGS; do
+  echo 1 > "$SYS/reset"
+  echo "$alg" > "$SYS/comp_algorithm" 2>/dev/null
+  if ! grep -q "\[$alg\]" "$SYS/comp_algorithm"; then
+    echo "跳过 $alg（内核未提供该算法）" >&2
+    continue
+  fi
+  echo "$CORPUS_BYTES" > "$SYS/disksize"
+
+  # 写入：页缓存回写时压缩，fsync 保证计时覆盖全部压缩
+  t0=$(now_ns)
+  taskset -c "$CPU" dd if="$CORPUS" of="$DEV" bs=1048576 conv=fsync 2>/dev/null
+  t1=$(now_ns)
+  write_ms=$(elapsed_ms "$t0" "$t1")
+  ratio=$(awk '{ if ($2 > 0) printf "%.2f", $1 / $2; else print "NaN" }' "$SYS/mm_stat")
+
+  # 读回：每轮先丢弃块设备页缓存，保证每一页都从 zram 解压
+  best_ms=
+  r=0
+  while [ $r -lt "$ROUNDS" ]; do
+    sync
+    echo 3 > /proc/sys/vm/drop_caches
+    t0=$(now_ns)
+    taskset -c "$CPU" dd if="$DEV" of=/dev/null bs=4096 2>/dev/null
+    t1=$(now_ns)
+    ms=$(elapsed_ms "$t0" "$t1")
+    best_ms=$(awk -v a="$ms" -v b="$best_ms" 'BEGIN { print (b == "" || a < b) ? a : b }')
+    r=$((r + 1))
+  done
+
+  awk -v alg="$alg" -v ratio="$ratio" -v w="$write_ms" -v r="$best_ms" \
+      -v bytes="$CORPUS_BYTES" -v pages="$PAGES" 'BEGIN {
+    printf "%-14s %8s %12.1f %12.1f %12.2f\n", alg, ratio,
+           bytes / 1048576 / (w / 1000), bytes / 1048576 / (r / 1000), r * 1000 / pages
+  }'
+done
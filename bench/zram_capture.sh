@@ -0,0 +1,151 @@
+#!/system/bin/sh
+# zram 换入/换出事件采集（设备端运行，需要 root 与内核 kprobe events 支持）
+#
+# 用 kprobe 事件跟踪 zram 的页读写（zram_rw_page、zram_submit_bio）与 swap 槽位释放（zram_slot_free_notify），
+# 记录每次换出/换入/释放的时间与槽位；同时每隔 DUMP_INTERVAL 秒把期间写入且仍在使用的槽位内容从
+# zram 块设备读出保存为语料。采集结果拷到电脑上后用 bench/zram_replay.py 在主机的 zram 上按原顺序与节奏回放，
+# 无需刷机即可对比算法、disksize 与各补丁的效果。
+#
+# 用法: sh zram_capture.sh [采集秒数] [输出目录]
+#   采集秒数默认 300，输出目录默认 /data/local/tmp/zram_capture
+# 环境变量: DEV=导出语料的 zram 设备(默认 zram0) DUMP_INTERVAL=语料导出间隔秒数(默认 5)
+#   kprobe 无法区分设备，有多个 zram 设备时各设备的事件会混在一起，采集时建议只保留一个设备
+# 输出:
+#   events.txt  每行 "时间(us) 操作 槽位"，操作 W=换出 R=换入 F=释放
+#   pages.bin   导出的页内容，每页 4096 字节
+#   pages.idx   每行 "事件序号 槽位"，第 N 行对应 pages.bin 中第 N 页，事件序号为该内容对应的那次写入
+
+DURATION=${1:-300}
+OUT=${2:-/data/local/tmp/zram_capture}
+DEV=${DEV:-zram0}
+DUMP_INTERVAL=${DUMP_INTERVAL:-5}
+BLKDEV=/dev/block/$DEV
+[ -e "$BLKDEV" ] || BLKDEV=/dev/$DEV
+GROUP=zramcap
+
+# ===== 环境检查 =====
+if [ "$(id -u)" != "0" ]; then
+  echo "请使用 root 运行" >&2
+  exit 1
+fi
+TRACEFS=/sys/kernel/tracing
+[ -e $TRACEFS/kprobe_events ] || TRACEFS=/sys/kernel/debug/tracing
+if [ ! -e $TRACEFS/kprobe_events ]; then
+  echo "内核未开启 kprobe events（CONFIG_KPROBE_EVENTS）" >&2
+  exit 1
+fi
+if [ ! -e "$BLKDEV" ]; then
+  echo "找不到 $DEV" >&2
+  exit 1
+fi
+mkdir -p "$OUT"
+rm -f "$OUT/events.txt" "$OUT/pages.bin" "$OUT/pages.idx"
+
+# zram 编译为模块时符号需要带 "zram:" 前缀，内置时不带
+add_probe() {
+  echo "p:$GROUP/$1 zram:$2 $3" >> $TRACEFS/kprobe_events 2>/dev/null \
+    || echo "p:$GROUP/$1 $2 $3" >> $TRACEFS/kprobe_events
+}
+
+cleanup() {
+  echo 0 > $TRACEFS/events/$GROUP/enable 2>/dev/null
+  for ev in rw bio free; do
+    echo "-:$GROUP/$ev" >> $TRACEFS/kprobe_events 2>/dev/null
+  done
+  [ -n "$PIPE_PID" ] && kill "$PIPE_PID" 2>/dev/null
+}
+trap cleanup EXIT INT TERM
+
+# ===== 注册 kprobe 事件 =====
+# arm64 调用约定：x0.. 依次为参数
+#   zram_rw_page(bdev, sector, page, op)
+#   zram_submit_bio(bio)：按 6.1 的 struct bio 布局，bi_opf 在 +16，bi_iter.bi_sector 在 +32，bi_size 在 +40
+#   zram_slot_free_notify(bdev, index)
+echo ">>> 注册 kprobe 事件..."
+add_probe rw zram_rw_page "sector=%x1:u64 op=%x3:u32" || exit 1
+add_probe bio zram_submit_bio "opf=+16(%x0):u32 sector=+32(%x0):u64 size=+40(%x0):u32" || exit 1
+add_probe free zram_slot_free_notify "index=%x1:u64" || exit 1
+echo > $TRACEFS/trace
+echo 4096 > $TRACEFS/buffer_size_kb
+
+# 把 trace 行转换为 "时间(us) 操作 槽位"；bio 按大小展开为多页，discard 视为释放。
+# 跳过本脚本导出语料时 dd 产生的读
+cat $TRACEFS/trace_pipe | awk '
+  $1 ~ /^dd-[0-9]+$/ { next }
+  {
+    for (i = 1; i <= NF; i++) {
+      if ($i ~ /^[0-9]+\.[0-9]+:$/) ts = substr($i, 1, length($i) - 1)
+      split($i, kv, "=")
+      v[kv[1]] = kv[2]
+    }
+    us = sprintf("%.0f", ts * 1e6)
+  }
+  / rw: / {
+    op = (v["op"] % 256 == 1) ? "W" : "R"
+    printf "%s %s %d\n", us, op, v["sector"] / 8
+    fflush()
+  }
+  / bio: / {
+    o = v["opf"] % 256
+    op = (o == 0) ? "R" : (o == 1) ? "W" : (o == 3) ? "F" : ""
+    if (op != "") {
+      for (p = 0; p < v["size"] / 4096; p++)
+        printf "%s %s %d\n", us, op, v["sector"] / 8 + p
+      fflush()
+    }
+  }
+  / free: / {
+    printf "%s F %d\n", us, v["index"]
+    fflush()
+  }' > "$OUT/events.txt" &
+PIPE_PID=$!
+
+echo 1 > $TRACEFS/events/$GROUP/enable
+echo ">>> 正在采集 $DEV ${DURATION}s，输出到 $OUT"
+
+# ===== 定期导出语料 =====
+# 找出上次导出后写入、且目前仍未释放的槽位，按连续区间用 dd 整段读出
+dumped=0
+dump_pages() {
+  # 事件文件仍在追加，记下本次实际读到的行数作为下次的起点
+  awk -v from="$dumped" -v nr="$OUT/dump.nr" '
+    { seq = NR - 1 }
+    $2 == "W" { last[$3] = seq; live[$3] = 1 }
+    $2 == "F" { delete live[$3] }
+    END {
+      print NR > nr
+      for (s in live)
+        if (last[s] >= from)
+          print s, last[s]
+    }' "$OUT/events.txt" | sort -n > "$OUT/dump.lst"
+  # swap 写入绕过块设备页缓存，上次 dd 缓存下来的页可能已过时，读之前先丢弃
+  blockdev --flushbufs "$BLKDEV"
+  awk '
+    NR == 1 || $1 != prev + 1 { if (NR > 1) print start, prev - start + 1; start = $1 }
+    { prev = $1 }
+    END { if (NR) print start, prev - start + 1 }' "$OUT/dump.lst" | while read -r start count; do
+    dd if="$BLKDEV" bs=4096 skip="$start" count="$count" 2>/dev/null >> "$OUT/pages.bin"
+  done
+  awk '{ print $2, $1 }' "$OUT/dump.lst" >> "$OUT/pages.idx"
+  dumped=$(cat "$OUT/dump.nr")
+}
+
+elapsed=0
+while [ $elapsed -lt "$DURATION" ]; do
+  sleep "$DUMP_INTERVAL"
+  elapsed=$((elapsed + DUMP_INTERVAL))
+  dump_pages
+done
+echo 0 > $TRACEFS/events/$GROUP/enable
+sleep 1
+dump_pages
+rm -f "$OUT/dump.lst" "$OUT/dump.nr"
+
+# ===== 汇总 =====
+awk -v pages="$(wc -l < "$OUT/pages.idx")" '
+  { n[$2]++ }
+  END {
+    printf "换出 %d 次，换入 %d 次，释放 %d 次；导出页内容 %d 页（覆盖 %.1f%% 的换出）\n",
+           n["W"], n["R"], n["F"], pages, n["W"] ? pages * 100 / n["W"] : 0
+  }' "$OUT/events.txt"
+echo "把 $OUT 拷贝到主机后运行: sudo ./bench/zram_replay.py <目录>"
@@ -0,0 +1,149 @@
+#!/system/bin/sh
+# zram 各压缩算法在各 CPU 簇上的能耗测试（设备端运行，需要 root，须拔掉充电器，建议熄屏后通过 adb 运行）
+#
+# 按 cpu_capacity 把 CPU 分簇。对每个簇、每个算法新建临时 zram 设备，绑定到该簇用 O_DIRECT 反复写入同一份语料
+# （O_DIRECT 下压缩在 dd 自身的上下文中完成，不会跑到回写线程所在的 CPU 上），写入期间采样电池电流与电压积分得到能耗，
+# 再减去写入前同等条件下的空闲功率，得到每 MiB 的压缩能耗（uJ/MiB）。
+# 结果写入表格，供 tools/zram_bg_policy.sh 为后台 zram 工作选择能耗最低的簇。
+#
+# 用法: sh zram_energy_bench.sh [算法列表] [语料文件]
+#   算法列表默认 "lz4 zstd"，内核未提供的算法自动跳过
+# 环境变量: SIZE_MB=语料大小(默认 64) MIN_SEC=每项至少写入的秒数(默认 10) IDLE_SEC=空闲功率采样秒数(默认 5)
+#   OUT=结果文件(默认 /data/adb/zram_energy.tsv)，每行 "算法 簇内CPU列表 容量 uJ/MiB MiB/s"
+
+ALGS=${1:-"lz4 zstd"}
+CORPUS=$2
+SIZE_MB=${SIZE_MB:-64}
+MIN_SEC=${MIN_SEC:-10}
+IDLE_SEC=${IDLE_SEC:-5}
+OUT=${OUT:-/data/adb/zram_energy.tsv}
+WORKDIR=/data/local/tmp/zram_energy_bench
+BAT=/sys/class/power_supply/battery
+
+# ===== 环境检查 =====
+if [ "$(id -u)" != "0" ]; then
+  echo "请使用 root 运行" >&2
+  exit 1
+fi
+if [ ! -e /sys/class/zram-control/hot_add ]; then
+  echo "内核不支持 zram-control/hot_add，无法创建测试设备" >&2
+  exit 1
+fi
+if [ ! -r $BAT/current_now ] || [ ! -r $BAT/voltage_now ]; then
+  echo "无法读取电池电流/电压（$BAT）" >&2
+  exit 1
+fi
+case "$(cat $BAT/status)" in
+  Charging|Full)
+    echo "充电时电池电流不反映实际功耗，请拔掉充电器后运行" >&2
+    exit 1 ;;
+esac
+mkdir -p "$WORKDIR"
+
+now_ns() {
+  date +%s%N
+}
+
+# 输出 "容量 CPU列表"，每簇一行，按容量从小到大
+list_clusters() {
+  for c in /sys/devices/system/cpu/cpu[0-9]*; do
+    [ -r "$c/cpu_capacity" ] && echo "$(cat "$c/cpu_capacity") ${c##*/cpu}"
+  done | sort -n -k1,1 -k2,2 | awk '
+    $1 != cap { if (cap != "") print cap, list; cap = $1; list = $2; next }
+    { list = list "," $2 }
+    END { if (cap != "") print cap, list }'
+}
+
+# 采样固定在 CPU0 上，空闲与写入两次采样的开销相互抵消
+start_sampling() {
+  touch "$WORKDIR/sampling"
+  taskset -c 0 sh -c "
+    while [ -e '$WORKDIR/sampling' ]; do
+      echo \"\$(date +%s%N) \$(cat $BAT/current_now) \$(cat $BAT/voltage_now)\"
+      sleep 0.1
+    done" > "$WORKDIR/power.txt" &
+  SAMPLER=$!
+}
+
+# 停止采样并输出 "平均功率(W) 时长(s)"；电流单位 uA、电压单位 uV，放电时电流的符号因机型而异，取绝对值
+stop_sampling() {
+  rm -f "$WORKDIR/sampling"
+  wait "$SAMPLER" 2>/dev/null
+  awk '
+    { i = $2 < 0 ? -$2 : $2; p = i * $3 / 1e12 }
+    NR > 1 { dt = ($1 - t) / 1e9; e += dt * (p + lp) / 2; d += dt }
+    { t = $1; lp = p }
+    END { if (d > 0) printf "%.6f %.3f\n", e / d, d; else print "0 0" }' "$WORKDIR/power.txt"
+}
+
+# ===== 准备语料 =====
+if [ -z "$CORPUS" ]; then
+  CORPUS="$WORKDIR/corpus.bin"
+  echo ">>> 正在生成 ${SIZE_MB}MB 语料..."
+  find /system/lib64 /data/dalvik-cache -type f 2>/dev/null | while read -r f; do
+    cat "$f"
+  done | head -c $((SIZE_MB * 1048576)) > "$CORPUS"
+fi
+CORPUS_BYTES=$(wc -c < "$CORPUS")
+CORPUS_BYTES=$((CORPUS_BYTES / 1048576 * 1048576))
+if [ "$CORPUS_BYTES" -eq 0 ]; then
+  echo "语料不足 1MB: $CORPUS" >&2
+  exit 1
+fi
+
+# ===== 创建临时 zram 设备 =====
+ID=$(cat /sys/class/zram-control/hot_add)
+SYS=/sys/block/zram$ID
+DEV=/dev/block/zram$ID
+[ -e "$DEV" ] || DEV=/dev/zram$ID
+
+cleanup() {
+  rm -f "$WORKDIR/sampling"
+  echo 1 > "$SYS/reset" 2>/dev/null
+  echo "$ID" > /sys/class/zram-control/hot_remove 2>/dev/null
+  [ "$CORPUS" = "$WORKDIR/corpus.bin" ] && rm -rf "$WORKDIR"
+}
+trap cleanup EXIT INT TERM
+
+echo ">>> 测试设备 zram$ID，语料 $CORPUS（$((CORPUS_BYTES / 1048576))MB），结果写入 $OUT"
+printf "%-14s %-12s %8s %12s %10s\n" "算法" "CPU" "容量" "uJ/MiB" "MiB/s"
+: > "$OUT.tmp"
+list_clusters | while read -r cap cpus; do
+  for alg in $ALGS; do
+    echo 1 > "$SYS/reset"
+    echo "$alg" > "$SYS/comp_algorithm" 2>/dev/null
+    if ! grep -q "\[$alg\]" "$SYS/comp_algorithm"; then
+      echo "跳过 $alg（内核未提供该算法）" >&2
+      continue
+    fi
+    echo "$CORPUS_BYTES" > "$SYS/disksize"
+
+    # 空闲功率：与写入时相同的采样条件，什么也不做
+    start_sampling
+    sleep "$IDLE_SEC"
+    idle=$(stop_sampling)
+
+    # 写入：至少 MIN_SEC 秒，电量计的电流读数通常按秒更新，太短的测量没有意义
+    start_sampling
+    t0=$(now_ns)
+    written=0
+    while :; do
+      taskset -c "$cpus" dd if="$CORPUS" of="$DEV" bs=1048576 oflag=direct 2>/dev/null
+      written=$((written + CORPUS_BYTES / 1048576))
+      t1=$(now_ns)
+      # 纳秒时间戳超出 shell 的整数范围，交给 awk 比较
+      awk -v a="$t0" -v b="$t1" -v s="$MIN_SEC" 'BEGIN { exit !((b - a) / 1e9 >= s) }' && break
+    done
+    busy=$(stop_sampling)
+
+    awk -v alg="$alg" -v cpus="$cpus" -v cap="$cap" -v mib="$written" -v out="$OUT.tmp" \
+        -v t0="$t0" -v t1="$t1" -v idle="$idle" -v busy="$busy" 'BEGIN {
+      split(idle, i, " "); split(busy, b, " ")
+      secs = (t1 - t0) / 1e9
+      uj = (b[1] - i[1]) * b[2] * 1e6 / mib
+      printf "%-14s %-12s %8d %12.0f %10.1f\n", alg, cpus, cap, uj, mib / secs
+      printf "%s %s %d %.0f %.1f\n", alg, cpus, cap, uj, mib / secs >> out
+    }'
+  done
+done
+mv "$OUT.tmp" "$OUT"
@@ -0,0 +1,192 @@
+#!/usr/bin/env python3
+# zram 负载回放（在普通 Linux 主机上运行，需要 root 与 zram 模块）
+#
+# 读取 bench/zram_capture.sh 在手机上采集的换出/换入/释放事件与页内容，新建一个临时 zram 设备，
+# 按原顺序（默认也按原节奏）回放：换出 = O_DIRECT 写入对应槽位，换入 = O_DIRECT 读回，释放 = BLKDISCARD。
+# 换出时使用采集到的该次写入的页内容；采集时未来得及导出的页用语料中的其他页按槽位与序号确定性地替代。
+# 回放结束后输出写入/读回的吞吐与延迟分位数，以及 mm_stat 中的压缩率与内存占用，
+# 用于在主机上复现地对比算法、disksize 以及 lz4/zstd 补丁、zram 补丁的效果（主机内核需打上同样的补丁）。
+#
+# 用法: sudo ./zram_replay.py <采集目录> [-a 算法列表] [-s 倍速] [-d disksize] [--verify]
+#   算法列表用逗号分隔，默认 "lz4,zstd"，内核未提供的算法自动跳过
+#   倍速默认 1（按采集时的时间间隔回放），0 表示不等待、尽快回放
+#   disksize 默认按事件中出现的最大槽位计算
+
+import argparse
+import fcntl
+import hashlib
+import mmap
+import os
+import struct
+import sys
+import time
+import zlib
+
+PAGE = 4096
+BLKDISCARD = 0x1277
+
+
+def load_capture(path):
+    events = []
+    with open(os.path.join(path, "events.txt")) as f:
+        for line in f:
+            parts = line.split()
+            # 采集被中断时最后一行可能不完整
+            if len(parts) != 3 or parts[1] not in ("W", "R", "F"):
+                continue
+            events.append((int(parts[0]), parts[1], int(parts[2])))
+
+    pages = {}
+    with open(os.path.join(path, "pages.idx")) as f:
+        for n, line in enumerate(f):
+            seq, _slot = line.split()
+            pages[int(seq)] = n
+    with open(os.path.join(path, "pages.bin"), "rb") as f:
+        corpus = f.read()
+    npages = len(corpus) // PAGE
+    pages = {seq: n for seq, n in pages.items() if n < npages}
+    if not npages:
+        sys.exit("语料为空: %s/pages.bin" % path)
+    return events, pages, corpus, npages
+
+
+class ZramDev:
+    def __init__(self, alg, disksize):
+        if not os.path.exists("/sys/class/zram-control"):
+            os.system("modprobe zram num_devices=0")
+        with open("/sys/class/zram-control/hot_add") as f:
+            self.id = int(f.read())
+        self.sys = "/sys/block/zram%d" % self.id
+        self.fd = -1
+        try:
+            self._write("comp_algorithm", alg)
+        except OSError:
+            pass
+        if "[%s]" % alg not in self._read("comp_algorithm"):
+            self.close()
+            raise LookupError(alg)
+        self._write("disksize", str(disksize))
+        self.fd = os.open("/dev/zram%d" % self.id, os.O_RDWR | os.O_DIRECT)
+
+    def _write(self, attr, val):
+        with open(os.path.join(self.sys, attr), "w") as f:
+            f.write(val)
+
+    def _read(self, attr):
+        with open(os.path.join(self.sys, attr)) as f:
+            return f.read()
+
+    def mm_stat(self):
+        return [int(x) for x in self._read("mm_stat").split()]
+
+    def close(self):
+        if self.fd >= 0:
+            os.close(self.fd)
+        self._write("reset", "1")
+        with open("/sys/class/zram-control/hot_remove", "w") as f:
+            f.write(str(self.id))
+
+
+def percentile(sorted_ns, p):
+    if not sorted_ns:
+        return float("nan")
+    return sorted_ns[min(len(sorted_ns) - 1, int(len(sorted_ns) * p / 100))] / 1000
+
+
+def replay(dev, events, pages, corpus, npages, speed, verify):
+    # O_DIRECT 要求缓冲区按页对齐，匿名 mmap 正好满足
+    buf = mmap.mmap(-1, PAGE)
+    lat = {"W": [], "R": []}
+    written = {}
+    skipped = mismatched = 0
+    start = time.monotonic()
+    t0 = events[0][0]
+
+    for seq, (us, op, slot) in enumerate(events):
+        if speed > 0:
+            delay = start + (us - t0) / 1e6 / speed - time.monotonic()
+            if delay > 0:
+                time.sleep(delay)
+        off = slot * PAGE
+        if op == "W":
+            n = pages.get(seq)
+            if n is None:
+                n = zlib.crc32(b"%d:%d" % (slot, seq)) % npages
+            buf[:] = corpus[n * PAGE:(n + 1) * PAGE]
+            t = time.perf_counter_ns()
+            os.pwrite(dev.fd, buf, off)
+            lat["W"].append(time.perf_counter_ns() - t)
+            written[slot] = zlib.crc32(buf) if verify else True
+        elif op == "R":
+            # 采集开始前换出的槽位没有内容可读，跳过
+            if slot not in written:
+                skipped += 1
+                continue
+            t = time.perf_counter_ns()
+            os.preadv(dev.fd, [buf], off)
+            lat["R"].append(time.perf_counter_ns() - t)
+            if verify and zlib.crc32(buf) != written[slot]:
+                mismatched += 1
+        else:
+            if written.pop(slot, None) is None:
+                continue
+            fcntl.ioctl(dev.fd, BLKDISCARD, struct.pack("QQ", off, PAGE))
+
+    return lat, skipped, mismatched
+
+
+def main():
+    ap = argparse.ArgumentParser(description="在主机 zram 上回放手机采集的换入/换出事件")
+    ap.add_argument("capture", help="zram_capture.sh 的输出目录")
+    ap.add_argument("-a", "--algs", default="lz4,zstd", help="逗号分隔的算法列表")
+    ap.add_argument("-s", "--speed", type=float, default=1.0, help="回放倍速，0 表示尽快回放")
+    ap.add_argument("-d", "--disksize", type=int, default=0, help="zram 大小（字节）")
+    ap.add_argument("--verify", action="store_true", help="校验读回内容与写入一致")
+    args = ap.parse_args()
+
+    if os.geteuid() != 0:
+        sys.exit("请使用 root 运行")
+
+    events, pages, corpus, npages = load_capture(args.capture)
+    if not events:
+        sys.exit("没有事件: %s/events.txt" % args.capture)
+    disksize = args.disksize or (max(e[2] for e in events) + 1) * PAGE
+    distinct = len({hashlib.sha1(corpus[n * PAGE:(n + 1) * PAGE]).digest() for n in range(npages)})
+    nw = sum(1 for e in events if e[1] == "W")
+    span = (events[-1][0] - events[0][0]) / 1e6
+    print(">>> 事件 %d 个（换出 %d），时长 %.1fs；语料 %d 页（去重后 %d 种内容），覆盖 %.1f%% 的换出"
+          % (len(events), nw, span, npages, distinct, len(pages) * 100 / max(nw, 1)))
+
+    print("%-14s %10s %8s %8s %8s %8s %10s %8s %8s %8s %8s %8s %8s %8s"
+          % ("算法", "写入MB/s", "写P50us", "写P99us", "写P999us", "写MAXus",
+             "读回MB/s", "读P50us", "读P99us", "读P999us", "读MAXus", "压缩率", "内存MB", "峰值MB"))
+    for alg in args.algs.split(","):
+        try:
+            dev = ZramDev(alg, disksize)
+        except LookupError:
+            print("跳过 %s（内核未提供该算法）" % alg, file=sys.stderr)
+            continue
+        try:
+            lat, skipped, mismatched = replay(dev, events, pages, corpus, npages,
+                                              args.speed, args.verify)
+            orig, compr, mem_used, _limit, mem_max = dev.mm_stat()[:5]
+        finally:
+            dev.close()
+
+        row = [alg]
+        for op in ("W", "R"):
+            ns = sorted(lat[op])
+            total = sum(ns)
+            row.append("%.1f" % (len(ns) * PAGE / 1048576 / (total / 1e9)) if total else "NaN")
+            row += ["%.1f" % percentile(ns, p) for p in (50, 99, 99.9)]
+            row.append("%.1f" % (ns[-1] / 1000 if ns else float("nan")))
+        row.append("%.2f" % (orig / compr) if compr else "NaN")
+        row.append("%.1f" % (mem_used / 1048576))
+        row.append("%.1f" % (mem_max / 1048576))
+        print("%-14s %10s %8s %8s %8s %8s %10s %8s %8s %8s %8s %8s %8s %8s" % tuple(row))
+        if skipped or mismatched:
+            print("    %s: 跳过采集前换出的换入 %d 次，读回内容不一致 %d 次" % (alg, skipped, mismatched))
+
+
+if __name__ == "__main__":
+    main()
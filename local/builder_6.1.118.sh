@@ -30,6 +30,10 @@ read -p "是否启用三星SSG IO调度器？(y/n，默认：y): " APPLY_SSG
 APPLY_SSG=${APPLY_SSG:-y}
 read -p "是否启用Re-Kernel？(y/n，默认：n): " APPLY_REKERNEL
 APPLY_REKERNEL=${APPLY_REKERNEL:-n}
+read -p "是否加入 schedhorizon 调频器？(y/n，默认：y): " APPLY_SCHEDHORIZON
+APPLY_SCHEDHORIZON=${APPLY_SCHEDHORIZON:-y}
+read -p "是否加入 f2fs 后台批量压缩接口？(y/n，默认：y): " APPLY_F2FS_COMPRESS
+APPLY_F2FS_COMPRESS=${APPLY_F2FS_COMPRESS:-y}
 read -p "是否安装风驰内核驱动（未完成）？(y/n，默认：n): " APPLY_SCX
 APPLY_SCX=${APPLY_SCX:-n}
 
@@ -53,6 +57,8 @@ echo "应用网络功能增强优化配置: $APPLY_BETTERNET"
 echo "应用 BBR 等算法: $APPLY_BBR"
 echo "启用三星SSG IO调度器: $APPLY_SSG"
 echo "启用Re-Kernel: $APPLY_REKERNEL"
+echo "加入 schedhorizon 调频器: $APPLY_SCHEDHORIZON"
+echo "加入 f2fs 后台批量压缩接口: $APPLY_F2FS_COMPRESS"
 echo "应用风驰内核驱动: $APPLY_SCX"
 echo "===================="
 echo
@@ -147,9 +153,38 @@ if [[ "$APPLY_LZ4" == "y" || "$APPLY_LZ4" == "Y" ]]; then
   cp ./oppo_oplus_realme_sm8650/zram_patch/001-lz4.patch ./common/
   cp ./oppo_oplus_realme_sm8650/zram_patch/lz4armv8.S ./common/lib
   cp ./oppo_oplus_realme_sm8650/zram_patch/002-zstd.patch ./common/
+  cp ./oppo_oplus_realme_sm8650/zram_patch/003-zstd-fastdec.patch ./common/
+  cp ./oppo_oplus_realme_sm8650/zram_patch/004-zstd-page-decode.patch ./common/
+  cp ./oppo_oplus_realme_sm8650/zram_patch/005-zstd-page-compress.patch ./common/
+  cp ./oppo_oplus_realme_sm8650/zram_patch/006-zram-packed-slot.patch ./common/
+  cp ./oppo_oplus_realme_sm8650/zram_patch/007-zram-auto-compact.patch ./common/
+  cp ./oppo_oplus_realme_sm8650/zram_patch/008-zram-huge-writeback.patch ./common/
+  cp ./oppo_oplus_realme_sm8650/zram_patch/009-lz4-decompress-accel-helper.patch ./common/
+  cp ./oppo_oplus_realme_sm8650/zram_patch/010-zram-async-compress.patch ./common/
+  cp ./oppo_oplus_realme_sm8650/zram_patch/011-zram-bg-energy-placement.patch ./common/
+  cp ./oppo_oplus_realme_sm8650/zram_patch/012-zram-size-stat.patch ./common/
+  cp ./oppo_oplus_realme_sm8650/zram_patch/013-lzo-rle-neon-decompress.patch ./common/
+  cp ./oppo_oplus_realme_sm8650/zram_patch/014-zram-keep-clean-swapin.patch ./common/
+  cp ./oppo_oplus_realme_sm8650/zram_patch/015-zram-neon-same-filled.patch ./common/
+  cp ./oppo_oplus_realme_sm8650/zram_patch/016-zram-lazy-access-time.patch ./common/
   cd "$WORKDIR/kernel_workspace/common"
   git apply -p1 < 001-lz4.patch || true
   patch -p1 < 002-zstd.patch || true
+  # 003 之后的补丁是本仓库按顺序维护的一组，不允许模糊匹配，任一补丁失败即终止编译
+  patch -p1 -F 0 < 003-zstd-fastdec.patch
+  patch -p1 -F 0 < 004-zstd-page-decode.patch
+  patch -p1 -F 0 < 005-zstd-page-compress.patch
+  patch -p1 -F 0 < 006-zram-packed-slot.patch
+  patch -p1 -F 0 < 007-zram-auto-compact.patch
+  patch -p1 -F 0 < 008-zram-huge-writeback.patch
+  patch -p1 -F 0 < 009-lz4-decompress-accel-helper.patch
+  patch -p1 -F 0 < 010-zram-async-compress.patch
+  patch -p1 -F 0 < 011-zram-bg-energy-placement.patch
+  patch -p1 -F 0 < 012-zram-size-stat.patch
+  patch -p1 -F 0 < 013-lzo-rle-neon-decompress.patch
+  patch -p1 -F 0 < 014-zram-keep-clean-swapin.patch
+  patch -p1 -F 0 < 015-zram-neon-same-filled.patch
+  patch -p1 -F 0 < 016-zram-lazy-access-time.patch
   cd "$WORKDIR/kernel_workspace"
 else
   echo ">>> 跳过 LZ4&ZSTD 补丁..."
@@ -215,6 +250,8 @@ if [[ "$USE_PATCH_LINUX" == "y" || "$USE_PATCH_LINUX" == "Y" ]]; then
 fi
 
 # 仅在启用了 LZ4KD 补丁时添加相关算法支持
+# zram 随内核一同编译为模块，打包时替换 zram.zip 中的预编译 zram.ko，
+# 保证模块的 vermagic 与符号 CRC 与本次编译的内核一致，并带上已应用的 zram 补丁
 if [[ "$APPLY_LZ4KD" == "y" || "$APPLY_LZ4KD" == "Y" ]]; then
   cat >> "$DEFCONFIG_FILE" <<EOF
 CONFIG_ZSMALLOC=y
@@ -222,7 +259,13 @@ CONFIG_CRYPTO_LZ4HC=y
 CONFIG_CRYPTO_LZ4K=y
 CONFIG_CRYPTO_LZ4KD=y
 CONFIG_CRYPTO_842=y
+CONFIG_ZRAM=m
+CONFIG_ZRAM_WRITEBACK=y
 EOF
+  # 访问时间跟踪仅在 016 补丁生效（访问时间改为按需分配）时开启，否则每个 zram 槽位固定多占 8 字节
+  if grep -q zram_track_access_alloc ./common/drivers/block/zram/zram_drv.c 2>/dev/null; then
+    echo "CONFIG_ZRAM_MEMORY_TRACKING=y" >> "$DEFCONFIG_FILE"
+  fi
 
 fi
 
@@ -290,6 +333,30 @@ if [[ "$APPLY_REKERNEL" == "y" || "$APPLY_REKERNEL" == "Y" ]]; then
   echo "CONFIG_REKERNEL=y" >> "$DEFCONFIG_FILE"
 fi
 
+# ===== 加入 schedhorizon 调频器 =====
+# 基于 schedutil，按簇提供升/降频间隔、分频段目标负载、能效频点停留与负载上升趋势预测等可调参数，
+# 编入内核但不设为默认调频器，开机后按簇写入 scaling_governor 切换
+if [[ "$APPLY_SCHEDHORIZON" == "y" || "$APPLY_SCHEDHORIZON" == "Y" ]]; then
+  echo ">>> 正在加入 schedhorizon 调频器..."
+  cd common
+  wget https://github.com/cctv18/oppo_oplus_realme_sm8650/raw/refs/heads/main/other_patch/schedhorizon.patch
+  patch -p1 -F 3 < schedhorizon.patch || true
+  cd ..
+  echo "CONFIG_CPU_FREQ_GOV_SCHEDHORIZON=y" >> "$DEFCONFIG_FILE"
+fi
+
+# ===== 加入 f2fs 后台批量压缩接口 =====
+# 新增 F2FS_IOC_COMPRESS_BATCH，在 I/O 与时间预算内压缩一批 inode，
+# 供 zram.zip 中的 f2fs_compress.sh 在充电且空闲时压缩冷文件（/data 须以 compress_mode=user 挂载）
+if [[ "$APPLY_F2FS_COMPRESS" == "y" || "$APPLY_F2FS_COMPRESS" == "Y" ]]; then
+  echo ">>> 正在加入 f2fs 后台批量压缩接口..."
+  cd common
+  wget https://github.com/cctv18/oppo_oplus_realme_sm8650/raw/refs/heads/main/other_patch/f2fs_compress_batch.patch
+  patch -p1 -F 3 < f2fs_compress_batch.patch || true
+  cd ..
+  echo "CONFIG_F2FS_FS_COMPRESSION=y" >> "$DEFCONFIG_FILE"
+fi
+
 # ===== 禁用 defconfig 检查 =====
 echo ">>> 禁用 defconfig 检查..."
 sed -i 's/check_defconfig//' ./common/build.config.gki
@@ -341,9 +408,34 @@ cp "$OUT_DIR/Image" ./AnyKernel3/
 echo ">>> 进入 AnyKernel3 目录并打包 zip..."
 cd "$WORKDIR/kernel_workspace/AnyKernel3"
 
-# ===== 如果启用 lz4kd，则下载 zram.zip 并放入当前目录 =====
+# ===== 如果启用 lz4kd，则下载 zram.zip 并放入当前目录，其中的 zram.ko 替换为本次编译的模块 =====
 if [[ "$APPLY_LZ4KD" == "y" || "$APPLY_LZ4KD" == "Y" ]]; then
   wget https://raw.githubusercontent.com/cctv18/oppo_oplus_realme_sm8650/refs/heads/main/zram.zip
+  ZRAM_KO="$WORKDIR/kernel_workspace/common/out/drivers/block/zram/zram.ko"
+  if [ -f "$ZRAM_KO" ]; then
+    echo ">>> 用本次编译的 zram.ko 替换 zram.zip 中的预编译模块..."
+    KOUT="$WORKDIR/kernel_workspace/common/out"
+    mkdir -p zram_ko
+    cp "$ZRAM_KO" zram_ko/zram.ko
+    llvm-strip-20 --strip-debug zram_ko/zram.ko
+    # 用本次编译生成并内置于内核的密钥签名，签名须在 strip 之后
+    if grep -q '^CONFIG_MODULE_SIG=y' "$KOUT/.config"; then
+      SIG_HASH=$(sed -n 's/^CONFIG_MODULE_SIG_HASH="\(.*\)"$/\1/p' "$KOUT/.config")
+      "$KOUT/scripts/sign-file" "$SIG_HASH" "$KOUT/certs/signing_key.pem" "$KOUT/certs/signing_key.x509" zram_ko/zram.ko
+    fi
+    (cd zram_ko && zip ../zram.zip zram.ko)
+    rm -rf zram_ko
+  else
+    echo ">>> 未找到编译出的 zram.ko，保留 zram.zip 中的预编译模块"
+  fi
+  # f2fs_compress.sh 调用的 f2fs_compress_batch 不依赖 libc，直接用编译内核的 clang 编译为静态程序
+  if [[ "$APPLY_F2FS_COMPRESS" == "y" || "$APPLY_F2FS_COMPRESS" == "Y" ]]; then
+    echo ">>> 编译 f2fs_compress_batch 并放入 zram.zip..."
+    wget https://raw.githubusercontent.com/cctv18/oppo_oplus_realme_sm8650/refs/heads/main/tools/f2fs_compress_batch.c
+    clang-20 --target=aarch64-linux-gnu -O2 -static -nostdlib -ffreestanding -fno-stack-protector -fuse-ld=lld \
+      -o f2fs_compress_batch f2fs_compress_batch.c && zip zram.zip f2fs_compress_batch
+    rm -f f2fs_compress_batch f2fs_compress_batch.c
+  fi
 fi
 
 # ===== 生成 ZIP 文件名 =====
@@ -0,0 +1,229 @@
+/*
+ * f2fs_compress_batch：调用 other_patch/f2fs_compress_batch.patch 提供的 F2FS_IOC_COMPRESS_BATCH，
+ * 在给定的 I/O 与时间预算内压缩一批 inode，供 zram.zip 中的 f2fs_compress.sh 在充电且空闲时分片调用。
+ *
+ * 用法: f2fs_compress_batch <f2fs 上的任意目录> <inode 列表文件> <起始序号> <起始页> <最多块数> <最多毫秒> [cold]
+ *   inode 列表每行一个 inode 号；最多块数/最多毫秒为 0 表示不限制；cold 表示只压缩 f2fs 判定为冷数据的文件
+ * 输出一行 "下次的起始序号 下次的起始页 本次重写的块数 本次跳过的文件数 列表中的文件数"
+ *
+ * 不依赖 libc，构建脚本中直接用编译内核的 clang 编译为静态程序:
+ *   clang --target=aarch64-linux-gnu -O2 -static -nostdlib -ffreestanding -fno-stack-protector \
+ *     -fuse-ld=lld -o f2fs_compress_batch f2fs_compress_batch.c
+ */
+
+typedef unsigned long long u64;
+typedef unsigned int u32;
+
+/* 与 include/uapi/linux/f2fs.h 中的定义保持一致 */
+struct f2fs_compress_batch {
+	u64 inos;
+	u32 count;
+	u32 next;
+	u64 pos;
+	u64 max_blocks;
+	u32 max_ms;
+	u32 flags;
+	u64 compressed;
+	u32 skipped;
+	u32 reserved;
+};
+
+#define F2FS_IOCTL_MAGIC		0xf5
+#define F2FS_IOC_COMPRESS_BATCH		((3UL << 30) | (sizeof(struct f2fs_compress_batch) << 16) | \
+					 (F2FS_IOCTL_MAGIC << 8) | 64)
+#define F2FS_COMPRESS_BATCH_COLD_ONLY	0x1
+
+#define AT_FDCWD	-100
+#define MAX_INODES	(1 << 18)
+#define LIST_BYTES	(MAX_INODES * 12)
+
+#if defined(__aarch64__)
+#define O_DIRECTORY	040000
+#define NR_IOCTL	29
+#define NR_OPENAT	56
+#define NR_CLOSE	57
+#define NR_READ		63
+#define NR_WRITE	64
+#define NR_EXIT_GROUP	94
+
+static long sys(long nr, long a, long b, long c, long d)
+{
+	register long x8 __asm__("x8") = nr;
+	register long x0 __asm__("x0") = a;
+	register long x1 __asm__("x1") = b;
+	register long x2 __asm__("x2") = c;
+	register long x3 __asm__("x3") = d;
+
+	__asm__ volatile("svc #0" : "+r"(x0) : "r"(x8), "r"(x1), "r"(x2), "r"(x3) : "memory");
+	return x0;
+}
+
+__asm__(".global _start\n_start:\n\tmov x0, sp\n\tbl start_c\n");
+#elif defined(__x86_64__)
+/* 仅用于在主机上调试 */
+#define O_DIRECTORY	0200000
+#define NR_IOCTL	16
+#define NR_OPENAT	257
+#define NR_CLOSE	3
+#define NR_READ		0
+#define NR_WRITE	1
+#define NR_EXIT_GROUP	231
+
+static long sys(long nr, long a, long b, long c, long d)
+{
+	register long r10 __asm__("r10") = d;
+	long ret;
+
+	__asm__ volatile("syscall" : "=a"(ret) : "a"(nr), "D"(a), "S"(b), "d"(c), "r"(r10)
+			 : "rcx", "r11", "memory");
+	return ret;
+}
+
+__asm__(".global _start\n_start:\n\tmov %rsp, %rdi\n\tand $-16, %rsp\n\tcall start_c\n");
+#else
+#error "unsupported architecture"
+#endif
+
+static u64 inos[MAX_INODES];
+static char list[LIST_BYTES];
+
+/* clang 可能为结构体清零生成 memset 调用 */
+void *memset(void *s, int c, unsigned long n)
+{
+	unsigned char *p = s;
+
+	while (n--)
+		*p++ = c;
+	return s;
+}
+
+static unsigned long slen(const char *s)
+{
+	unsigned long n = 0;
+
+	while (s[n])
+		n++;
+	return n;
+}
+
+static void put(int fd, const char *s)
+{
+	sys(NR_WRITE, fd, (long)s, slen(s), 0);
+}
+
+static void put_num(int fd, u64 v)
+{
+	char buf[24];
+	int i = sizeof(buf) - 1;
+
+	buf[i] = '\0';
+	do {
+		buf[--i] = '0' + v % 10;
+		v /= 10;
+	} while (v);
+	put(fd, buf + i);
+}
+
+static __attribute__((noreturn)) void quit(int code)
+{
+	sys(NR_EXIT_GROUP, code, 0, 0, 0);
+	__builtin_unreachable();
+}
+
+static __attribute__((noreturn)) void fail(const char *what, long err)
+{
+	put(2, what);
+	put(2, ": errno ");
+	put_num(2, -err);
+	put(2, "\n");
+	quit(1);
+}
+
+static int parse(const char *s, u64 *v)
+{
+	*v = 0;
+	if (!*s)
+		return -1;
+	for (; *s; s++) {
+		if (*s < '0' || *s > '9')
+			return -1;
+		*v = *v * 10 + (*s - '0');
+	}
+	return 0;
+}
+
+static u32 read_list(const char *path)
+{
+	long fd, n, len = 0;
+	u32 count = 0;
+	u64 v = 0;
+	int digits = 0;
+	long i;
+
+	fd = sys(NR_OPENAT, AT_FDCWD, (long)path, 0, 0);
+	if (fd < 0)
+		fail(path, fd);
+	while (len < LIST_BYTES && (n = sys(NR_READ, fd, (long)(list + len), LIST_BYTES - len, 0)) > 0)
+		len += n;
+	sys(NR_CLOSE, fd, 0, 0, 0);
+
+	/* 末尾补一个分隔符，最后一行没有换行时也能计入 */
+	for (i = 0; i <= len && count < MAX_INODES; i++) {
+		char c = i < len ? list[i] : '\n';
+
+		if (c >= '0' && c <= '9') {
+			v = v * 10 + (c - '0');
+			digits = 1;
+		} else {
+			if (digits)
+				inos[count++] = v;
+			v = 0;
+			digits = 0;
+		}
+	}
+	return count;
+}
+
+void start_c(long *sp)
+{
+	int argc = (int)sp[0];
+	char **argv = (char **)(sp + 1);
+	struct f2fs_compress_batch b = { 0 };
+	u64 next, pos, max_blocks, max_ms;
+	long fd, ret;
+
+	if (argc < 7 || parse(argv[3], &next) || parse(argv[4], &pos) ||
+	    parse(argv[5], &max_blocks) || parse(argv[6], &max_ms)) {
+		put(2, "用法: f2fs_compress_batch <目录> <inode列表> <起始序号> <起始页> <最多块数> <最多毫秒> [cold]\n");
+		quit(2);
+	}
+
+	b.count = read_list(argv[2]);
+	b.inos = (u64)(unsigned long)inos;
+	b.next = next;
+	b.pos = pos;
+	b.max_blocks = max_blocks;
+	b.max_ms = max_ms;
+	if (argc > 7 && argv[7][0] == 'c')
+		b.flags = F2FS_COMPRESS_BATCH_COLD_ONLY;
+
+	fd = sys(NR_OPENAT, AT_FDCWD, (long)argv[1], O_DIRECTORY, 0);
+	if (fd < 0)
+		fail(argv[1], fd);
+	ret = sys(NR_IOCTL, fd, F2FS_IOC_COMPRESS_BATCH, (long)&b, 0);
+	sys(NR_CLOSE, fd, 0, 0, 0);
+	if (ret < 0)
+		fail("F2FS_IOC_COMPRESS_BATCH", ret);
+
+	put_num(1, b.next);
+	put(1, " ");
+	put_num(1, b.pos);
+	put(1, " ");
+	put_num(1, b.compressed);
+	put(1, " ");
+	put_num(1, b.skipped);
+	put(1, " ");
+	put_num(1, b.count);
+	put(1, "\n");
+	quit(0);
+}
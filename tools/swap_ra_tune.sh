@@ -0,0 +1,79 @@
+#!/system/bin/sh
+# 按实测命中率自适应调整 zram swap 预读窗口（设备端运行，需要 root）
+#
+# 6.1 内核默认使用按 VMA 的 swap 预读（/sys/kernel/mm/swap/vma_ra_enabled）：每个 VMA 记录自己的
+# 预读命中次数，命中少时窗口缩到 1 页，顺序访问（如 Java 大数组）时逐步放大，但上限固定为
+# 2^page-cluster。磁盘上预读未命中只是多读了几个块、还能掩盖 IO 时延；zram 上每个未命中的页都是
+# 白白解压一次并占用一页内存，所以上限本身也应随负载变化。
+# 本脚本周期性读取 /proc/vmstat 中的 swap_ra（预读页数）与 swap_ra_hit（其中被实际用到的页数），
+# 命中率低时调小 page-cluster，命中率高时调大。
+#
+# 用法: 放入 /data/adb/service.d/ 开机执行，或手动 sh swap_ra_tune.sh [once]
+# 可通过同目录下的 swap_ra_tune.conf 覆盖以下参数:
+#   INTERVAL=采样间隔秒数 MIN_RA=统计有效所需的最少预读页数
+#   LOW=命中率低于此百分比时缩小 HIGH=高于此百分比时放大 MIN_CLUSTER/MAX_CLUSTER=page-cluster 范围
+
+SCRIPT_DIR=${0%/*}
+INTERVAL=30
+MIN_RA=256
+LOW=30
+HIGH=70
+MIN_CLUSTER=0
+MAX_CLUSTER=3
+[ -f "$SCRIPT_DIR/swap_ra_tune.conf" ] && . "$SCRIPT_DIR/swap_ra_tune.conf"
+LOG_TAG=swap_ra_tune
+PAGE_CLUSTER=/proc/sys/vm/page-cluster
+
+plog() {
+  /system/bin/log -t "$LOG_TAG" "$*" 2>/dev/null || echo "$LOG_TAG: $*"
+}
+
+vmstat_get() {
+  awk -v k="$1" '$1 == k { print $2; found = 1 } END { if (!found) print 0 }' /proc/vmstat
+}
+
+# 根据区间内的预读页数与命中页数给出新的 page-cluster，样本不足时保持不变
+next_cluster() {
+  awk -v ra="$1" -v hit="$2" -v cur="$3" -v min_ra="$MIN_RA" -v low="$LOW" -v high="$HIGH" \
+      -v lo="$MIN_CLUSTER" -v hi="$MAX_CLUSTER" 'BEGIN {
+    if (ra < min_ra) { print cur; exit }
+    rate = hit * 100 / ra
+    if (rate < low && cur > lo) cur--
+    else if (rate > high && cur < hi) cur++
+    print cur
+  }'
+}
+
+if [ "$(id -u)" != "0" ]; then
+  echo "请使用 root 运行" >&2
+  exit 1
+fi
+if ! grep -q '^swap_ra ' /proc/vmstat; then
+  plog "内核未提供 swap_ra 统计，退出"
+  exit 1
+fi
+
+# 窗口按 VMA 自适应依赖 vma_ra_enabled，关闭时只能退化为全局的按 swap 偏移预读
+[ -w /sys/kernel/mm/swap/vma_ra_enabled ] && echo 1 > /sys/kernel/mm/swap/vma_ra_enabled
+
+prev_ra=$(vmstat_get swap_ra)
+prev_hit=$(vmstat_get swap_ra_hit)
+while true; do
+  sleep "$INTERVAL"
+  ra=$(vmstat_get swap_ra)
+  hit=$(vmstat_get swap_ra_hit)
+  d_ra=$((ra - prev_ra))
+  d_hit=$((hit - prev_hit))
+  cur=$(cat "$PAGE_CLUSTER")
+  new=$(next_cluster "$d_ra" "$d_hit" "$cur")
+  if [ "$new" != "$cur" ]; then
+    echo "$new" > "$PAGE_CLUSTER"
+    plog "预读 $d_ra 页，命中 $d_hit 页，page-cluster $cur -> $new"
+  fi
+  # 样本不足时继续累计，避免低负载下在噪声上来回调整
+  if [ "$d_ra" -ge "$MIN_RA" ]; then
+    prev_ra=$ra
+    prev_hit=$hit
+  fi
+  [ "$1" = "once" ] && exit 0
+done
@@ -0,0 +1,70 @@
+#!/system/bin/sh
+# 按网卡选择 TCP 拥塞控制算法（设备端运行，需要 root）
+#
+# 内核只有一个全局 tcp_congestion_control，但路由可以单独指定 congctl（RTAX_CC_ALGO），
+# 新建连接时内核会优先使用所走路由上的算法，无需修改内核。
+# 安卓 netd 为每个网络建立以网卡命名的路由表（wlan0、rmnet_data0 等），本脚本把各表中的路由
+# 按下方规则重写为带 congctl 的版本，并在 netd 重建路由时重新应用。
+#
+# 用法: 放入 /data/adb/service.d/ 开机执行，或手动 sh tcp_cong_policy.sh [once]
+# 规则格式 "网卡通配符=算法"，按顺序匹配，可通过同目录下的 tcp_cong_policy.conf 覆盖:
+#   RULES="wlan*=cubic rmnet*=bbr ccmni*=bbr"
+# 按 UID 选择算法需要 sockops BPF 程序在 connect 时 setsockopt，超出本脚本范围。
+
+SCRIPT_DIR=${0%/*}
+RULES="wlan*=cubic rmnet*=bbr ccmni*=bbr"
+[ -f "$SCRIPT_DIR/tcp_cong_policy.conf" ] && . "$SCRIPT_DIR/tcp_cong_policy.conf"
+LOG_TAG=tcp_cong_policy
+
+plog() {
+  /system/bin/log -t "$LOG_TAG" "$*" 2>/dev/null || echo "$LOG_TAG: $*"
+}
+
+alg_for_iface() {
+  for rule in $RULES; do
+    case "$1" in
+      ${rule%%=*}) echo "${rule#*=}"; return ;;
+    esac
+  done
+}
+
+apply_iface() {
+  local iface=$1 alg=$2 family route
+  if ! grep -qw "$alg" /proc/sys/net/ipv4/tcp_available_congestion_control; then
+    plog "$iface: 内核未提供 $alg，跳过"
+    return
+  fi
+  for family in -4 -6; do
+    ip $family route show table "$iface" 2>/dev/null | while read -r route; do
+      case "$route" in
+        *" congctl $alg"*) continue ;;
+        *" congctl "*) route=$(echo "$route" | sed 's/ congctl [^ ]*//') ;;
+      esac
+      ip $family route replace $route table "$iface" congctl "$alg" 2>/dev/null \
+        && plog "$iface: $route -> $alg"
+    done
+  done
+}
+
+apply_all() {
+  for dev in /sys/class/net/*; do
+    iface=${dev##*/}
+    alg=$(alg_for_iface "$iface")
+    [ -n "$alg" ] && apply_iface "$iface" "$alg"
+  done
+}
+
+# 等待开机完成，netd 建好路由表后再应用
+until [ "$(getprop sys.boot_completed)" = "1" ]; do
+  sleep 5
+done
+apply_all
+[ "$1" = "once" ] && exit 0
+
+# 网络切换时 netd 会删除并重建路由，监听路由变化后去抖重新应用
+ip monitor route 2>/dev/null | while read -r _; do
+  sleep 2
+  # 读空积压的事件，避免同一次切换触发多次重写
+  while read -t 1 -r _; do :; done
+  apply_all
+done
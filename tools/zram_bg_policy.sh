@@ -0,0 +1,116 @@
+#!/system/bin/sh
+# 按充电与屏幕状态调度 zram 后台工作（设备端运行，需要 root）
+#
+# zram 的后台工作（zsmalloc 碎片整理、把空闲页回写到后备设备）不该出现在用户的耗电排行里：
+#   充电且熄屏：集中进行，主动整理碎片，并把长时间未访问的页回写到后备设备（配置了 backing_dev 时）
+#   使用电池且熄屏：只在碎片率较高时由内核的后台整理线程处理
+#   亮屏：关闭后台碎片整理（compact_threshold=0），不与前台争抢 CPU 与电量
+# 本脚本触发的整理与回写在写 sysfs 的进程上下文中执行，因此绑定到能耗最低的簇并以最低优先级运行：
+# 优先按 bench/zram_energy_bench.sh 实测的当前算法 uJ/MiB 选择，没有测量结果时取 cpu_capacity 最小的簇。
+# 内核中的后台整理线程由 zram_patch/011-zram-bg-energy-placement.patch 按 Energy Model 选择簇与频率上限。
+#
+# 用法: 放入 /data/adb/service.d/ 开机执行，或手动 sh zram_bg_policy.sh [once]
+# 可通过同目录下的 zram_bg_policy.conf 覆盖以下参数:
+#   INTERVAL=检测间隔秒数 CHARGE_THRESHOLD/BATTERY_THRESHOLD=充电熄屏/用电池熄屏时的 compact_threshold
+#   IDLE_WB_INTERVAL=充电熄屏时空闲页回写的间隔秒数（页在两次回写之间未被访问才算空闲）
+#   ENERGY_TABLE=zram_energy_bench.sh 的结果文件
+
+SCRIPT_DIR=${0%/*}
+INTERVAL=60
+CHARGE_THRESHOLD=10
+BATTERY_THRESHOLD=30
+IDLE_WB_INTERVAL=3600
+ENERGY_TABLE=/data/adb/zram_energy.tsv
+[ -f "$SCRIPT_DIR/zram_bg_policy.conf" ] && . "$SCRIPT_DIR/zram_bg_policy.conf"
+LOG_TAG=zram_bg_policy
+BAT=/sys/class/power_supply/battery
+
+plog() {
+  /system/bin/log -t "$LOG_TAG" "$*" 2>/dev/null || echo "$LOG_TAG: $*"
+}
+
+is_charging() {
+  case "$(cat $BAT/status 2>/dev/null)" in
+    Charging|Full) return 0 ;;
+  esac
+  return 1
+}
+
+# 息屏时 mWakefulness 为 Asleep 或 Dozing
+is_screen_on() {
+  dumpsys power 2>/dev/null | grep -q 'mWakefulness=Awake'
+}
+
+# 后台工作所用的 CPU 列表：当前算法实测能耗最低的簇，否则为容量最小的簇
+pick_cpus() {
+  local alg cpus
+  alg=$(cat /sys/block/zram0/comp_algorithm 2>/dev/null | grep -o '\[[^]]*\]' | tr -d '[]')
+  if [ -f "$ENERGY_TABLE" ]; then
+    cpus=$(awk -v a="$alg" '$1 == a && (best == "" || $4 < best) { best = $4; c = $2 } END { print c }' "$ENERGY_TABLE")
+  fi
+  if [ -z "$cpus" ]; then
+    cpus=$(for c in /sys/devices/system/cpu/cpu[0-9]*; do
+      [ -r "$c/cpu_capacity" ] && echo "$(cat "$c/cpu_capacity") ${c##*/cpu}"
+    done | sort -n | awk 'NR == 1 { min = $1 } $1 == min { l = l (l == "" ? "" : ",") $2 } END { print l }')
+  fi
+  echo "${cpus:-0}"
+}
+
+# 在选定的簇上以最低优先级写 sysfs：$1=文件 $2=内容
+bg_write() {
+  taskset -c "$CPUS" nice -n 19 sh -c "echo $2 > $1" 2>/dev/null
+}
+
+set_threshold() {
+  for sys in /sys/block/zram*; do
+    [ -w "$sys/compact_threshold" ] && echo "$1" > "$sys/compact_threshold"
+  done
+}
+
+maintenance() {
+  for sys in /sys/block/zram*; do
+    [ "$(cat "$sys/initstate" 2>/dev/null)" = "1" ] || continue
+    bg_write "$sys/compact" 1
+    # 回写上一轮标记后一直未被访问的页，再重新标记，下一轮回写这段时间里仍未访问的页
+    backing=$(cat "$sys/backing_dev" 2>/dev/null)
+    if [ -n "$backing" ] && [ "$backing" != "none" ] && [ $((now - last_wb)) -ge "$IDLE_WB_INTERVAL" ]; then
+      [ "$last_wb" -gt 0 ] && bg_write "$sys/writeback" idle
+      bg_write "$sys/idle" all
+      wb_done=1
+    fi
+  done
+  [ -n "$wb_done" ] && last_wb=$now
+  wb_done=
+}
+
+if [ "$(id -u)" != "0" ]; then
+  echo "请使用 root 运行" >&2
+  exit 1
+fi
+
+CPUS=$(pick_cpus)
+plog "后台 zram 工作使用 CPU $CPUS"
+state=
+last_wb=0
+while true; do
+  now=$(cut -d. -f1 /proc/uptime)
+  if is_screen_on; then
+    new=screen_on
+  elif is_charging; then
+    new=charging
+  else
+    new=battery
+  fi
+  if [ "$new" != "$state" ]; then
+    case "$new" in
+      screen_on) set_threshold 0 ;;
+      charging) set_threshold "$CHARGE_THRESHOLD" ;;
+      battery) set_threshold "$BATTERY_THRESHOLD" ;;
+    esac
+    plog "状态 ${state:-无} -> $new"
+    state=$new
+  fi
+  [ "$state" = "charging" ] && maintenance
+  [ "$1" = "once" ] && exit 0
+  sleep "$INTERVAL"
+done